@@ -0,0 +1,149 @@
+// Runs a scripted election (create, N votes, close, evaluate) against the chaincode
+// through the in-process shim, and writes per-operation latency and state access as JSON.
+//
+// usage: election_bench [num_votes] [output.json]
+
+#include "shim.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#define MAX_RESPONSE_SIZE 65536
+#define ELECTION_NAME "electionBench"
+
+typedef struct operation_t
+{
+    std::string name;
+    std::vector<double> latencies_us;
+    shim_stats_t stats;
+} operation_t;
+
+static void invoke_operation(
+    t_shim_ctx_t* ctx, operation_t* operation, std::vector<std::string> params, std::string creator
+)
+{
+    ctx->function_name = operation->name;
+    ctx->params = params;
+    ctx->creator_msp_id = "Org1MSP";
+    ctx->creator_dn = "CN=" + creator;
+    shim_stats_t before = ctx->stats;
+
+    uint8_t response[MAX_RESPONSE_SIZE];
+    uint32_t response_len = 0;
+    auto start = std::chrono::steady_clock::now();
+    int ret = invoke(response, sizeof(response), &response_len, ctx);
+    auto end = std::chrono::steady_clock::now();
+
+    if (ret != 0)
+    {
+        fprintf(stderr, "%s failed\n", operation->name.c_str());
+        exit(1);
+    }
+
+    operation->latencies_us.push_back(
+        std::chrono::duration<double, std::micro>(end - start).count()
+    );
+    operation->stats.state_reads += ctx->stats.state_reads - before.state_reads;
+    operation->stats.state_writes += ctx->stats.state_writes - before.state_writes;
+    operation->stats.bytes_read += ctx->stats.bytes_read - before.bytes_read;
+    operation->stats.bytes_written += ctx->stats.bytes_written - before.bytes_written;
+}
+
+// Nearest-rank percentile of the sorted latencies
+static double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+
+    size_t rank = (size_t)(p * sorted.size() + 0.5);
+    return sorted[std::min(std::max(rank, (size_t)1), sorted.size()) - 1];
+}
+
+static void write_results(FILE* out, uint64_t num_votes, std::vector<operation_t>& operations)
+{
+    fprintf(out, "{\n  \"implementation\": \"sgx-cpp\",\n  \"votes\": %llu,\n  \"operations\": [\n",
+        (unsigned long long)num_votes);
+
+    for (size_t i = 0; i < operations.size(); i++)
+    {
+        operation_t& op = operations[i];
+        std::vector<double> sorted(op.latencies_us);
+        std::sort(sorted.begin(), sorted.end());
+
+        double total = 0;
+        for (double latency : sorted)
+        {
+            total += latency;
+        }
+
+        fprintf(out,
+            "    {\"operation\": \"%s\", \"calls\": %zu, \"total_us\": %.1f, \"mean_us\": %.1f, "
+            "\"p50_us\": %.1f, \"p99_us\": %.1f, \"max_us\": %.1f, "
+            "\"state_reads\": %llu, \"state_writes\": %llu, \"bytes_read\": %llu, \"bytes_written\": %llu}%s\n",
+            op.name.c_str(), sorted.size(), total, sorted.empty() ? 0 : total / sorted.size(),
+            percentile(sorted, 0.50), percentile(sorted, 0.99), percentile(sorted, 1.0),
+            (unsigned long long)op.stats.state_reads, (unsigned long long)op.stats.state_writes,
+            (unsigned long long)op.stats.bytes_read, (unsigned long long)op.stats.bytes_written,
+            (i + 1 < operations.size()) ? "," : ""
+        );
+    }
+
+    fprintf(out, "  ]\n}\n");
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t num_votes = (argc > 1) ? strtoull(argv[1], NULL, 10) : 1000;
+    const char* output_path = (argc > 2) ? argv[2] : NULL;
+
+    const char* candidates[] = {"ben", "simon", "jim"};
+    t_shim_ctx_t ctx = {};
+
+    std::vector<operation_t> operations(5);
+    operations[0].name = "init";
+    operations[1].name = "CreateElection";
+    operations[2].name = "SubmitVote";
+    operations[3].name = "CloseElection";
+    operations[4].name = "EvaluateElection";
+
+    invoke_operation(&ctx, &operations[0], {ELECTION_NAME}, "organizer");
+    invoke_operation(
+        &ctx, &operations[1], {ELECTION_NAME, candidates[0], candidates[1], candidates[2]}, "organizer"
+    );
+
+    // one vote per second, starting from a fixed time so runs are comparable
+    uint64_t submitted_at = 1600000000;
+    for (uint64_t i = 0; i < num_votes; i++)
+    {
+        std::string voter = "voter" + std::to_string(i);
+        invoke_operation(
+            &ctx, &operations[2],
+            {ELECTION_NAME, voter, candidates[i % 3], std::to_string(submitted_at + i)},
+            voter
+        );
+    }
+
+    invoke_operation(&ctx, &operations[3], {ELECTION_NAME}, "organizer");
+    invoke_operation(&ctx, &operations[4], {ELECTION_NAME}, "organizer");
+
+    FILE* out = output_path ? fopen(output_path, "w") : stdout;
+    if (out == NULL)
+    {
+        fprintf(stderr, "Could not open %s\n", output_path);
+        return 1;
+    }
+
+    write_results(out, num_votes, operations);
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    return 0;
+}
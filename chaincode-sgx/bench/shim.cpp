@@ -0,0 +1,119 @@
+#include "shim.h"
+
+#include <cstring>
+
+// Copy a value out of the ledger; like the FPC shim, values that do not fit read as empty
+static void read_value(
+    std::map<std::string, std::string>& ledger,
+    const char* key, uint8_t* val, uint32_t max_val_len, uint32_t* val_len,
+    shim_ctx_ptr_t ctx
+)
+{
+    ctx->stats.state_reads += 1;
+    *val_len = 0;
+
+    auto it = ledger.find(key);
+    if (it == ledger.end() || it->second.size() > max_val_len)
+    {
+        return;
+    }
+
+    memcpy(val, it->second.data(), it->second.size());
+    *val_len = it->second.size();
+    ctx->stats.bytes_read += it->second.size();
+}
+
+static void write_value(
+    std::map<std::string, std::string>& ledger,
+    const char* key, uint8_t* val, uint32_t val_len,
+    shim_ctx_ptr_t ctx
+)
+{
+    ctx->stats.state_writes += 1;
+    ctx->stats.bytes_written += strlen(key) + val_len;
+    ledger[key] = std::string((const char*)val, val_len);
+}
+
+// Every key of the range counts as one read
+static void read_range(
+    std::map<std::string, std::string>& ledger,
+    const char* comp_key, std::map<std::string, std::string>& values,
+    shim_ctx_ptr_t ctx
+)
+{
+    std::string prefix(comp_key);
+    for (auto it = ledger.lower_bound(prefix); it != ledger.end(); ++it)
+    {
+        if (it->first.compare(0, prefix.size(), prefix) != 0)
+        {
+            break;
+        }
+
+        values.insert(*it);
+        ctx->stats.state_reads += 1;
+        ctx->stats.bytes_read += it->second.size();
+    }
+}
+
+void get_creator_name(
+    char* msp_id, uint32_t max_msp_id_len, char* dn, uint32_t max_dn_len, shim_ctx_ptr_t ctx
+)
+{
+    strncpy(msp_id, ctx->creator_msp_id.c_str(), max_msp_id_len - 1);
+    msp_id[max_msp_id_len - 1] = '\0';
+    strncpy(dn, ctx->creator_dn.c_str(), max_dn_len - 1);
+    dn[max_dn_len - 1] = '\0';
+}
+
+void get_state(
+    const char* key, uint8_t* val, uint32_t max_val_len, uint32_t* val_len, shim_ctx_ptr_t ctx
+)
+{
+    read_value(ctx->state, key, val, max_val_len, val_len, ctx);
+}
+
+void put_state(const char* key, uint8_t* val, uint32_t val_len, shim_ctx_ptr_t ctx)
+{
+    write_value(ctx->state, key, val, val_len, ctx);
+}
+
+void get_state_by_partial_composite_key(
+    const char* comp_key, std::map<std::string, std::string>& values, shim_ctx_ptr_t ctx
+)
+{
+    read_range(ctx->state, comp_key, values, ctx);
+}
+
+void del_state(const char* key, shim_ctx_ptr_t ctx)
+{
+    ctx->stats.state_writes += 1;
+    ctx->state.erase(key);
+}
+
+void get_public_state(
+    const char* key, uint8_t* val, uint32_t max_val_len, uint32_t* val_len, shim_ctx_ptr_t ctx
+)
+{
+    read_value(ctx->public_state, key, val, max_val_len, val_len, ctx);
+}
+
+void put_public_state(const char* key, uint8_t* val, uint32_t val_len, shim_ctx_ptr_t ctx)
+{
+    write_value(ctx->public_state, key, val, val_len, ctx);
+}
+
+void get_public_state_by_partial_composite_key(
+    const char* comp_key, std::map<std::string, std::string>& values, shim_ctx_ptr_t ctx
+)
+{
+    read_range(ctx->public_state, comp_key, values, ctx);
+}
+
+int get_func_and_params(
+    std::string& func_name, std::vector<std::string>& params, shim_ctx_ptr_t ctx
+)
+{
+    func_name = ctx->function_name;
+    params = ctx->params;
+    return 0;
+}
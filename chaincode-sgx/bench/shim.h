@@ -0,0 +1,69 @@
+#pragma once
+
+// In-process stand-in for the FPC shim, used to run the chaincode natively in the benchmark.
+// It keeps the ledger in memory and counts the state accesses of every transaction.
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// Log lines are dropped, but their arguments are still evaluated and checked against the format
+static inline void shim_log(const char* format, ...) __attribute__((format(printf, 1, 2)));
+static inline void shim_log(const char*, ...) {}
+
+#define LOG_DEBUG(...) shim_log(__VA_ARGS__)
+#define LOG_INFO(...) shim_log(__VA_ARGS__)
+#define LOG_WARNING(...) shim_log(__VA_ARGS__)
+#define LOG_ERROR(...) shim_log(__VA_ARGS__)
+
+typedef struct shim_stats_t
+{
+    uint64_t state_reads;
+    uint64_t state_writes;
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+} shim_stats_t;
+
+typedef struct t_shim_ctx_t
+{
+    std::map<std::string, std::string> state;
+    std::map<std::string, std::string> public_state;
+    std::string creator_msp_id;
+    std::string creator_dn;
+    std::string function_name;
+    std::vector<std::string> params;
+    shim_stats_t stats;
+} t_shim_ctx_t;
+
+typedef t_shim_ctx_t* shim_ctx_ptr_t;
+
+void get_creator_name(
+    char* msp_id, uint32_t max_msp_id_len, char* dn, uint32_t max_dn_len, shim_ctx_ptr_t ctx
+);
+
+void get_state(
+    const char* key, uint8_t* val, uint32_t max_val_len, uint32_t* val_len, shim_ctx_ptr_t ctx
+);
+void put_state(const char* key, uint8_t* val, uint32_t val_len, shim_ctx_ptr_t ctx);
+void get_state_by_partial_composite_key(
+    const char* comp_key, std::map<std::string, std::string>& values, shim_ctx_ptr_t ctx
+);
+void del_state(const char* key, shim_ctx_ptr_t ctx);
+
+void get_public_state(
+    const char* key, uint8_t* val, uint32_t max_val_len, uint32_t* val_len, shim_ctx_ptr_t ctx
+);
+void put_public_state(const char* key, uint8_t* val, uint32_t val_len, shim_ctx_ptr_t ctx);
+void get_public_state_by_partial_composite_key(
+    const char* comp_key, std::map<std::string, std::string>& values, shim_ctx_ptr_t ctx
+);
+
+int get_func_and_params(
+    std::string& func_name, std::vector<std::string>& params, shim_ctx_ptr_t ctx
+);
+
+// Implemented by the chaincode
+int invoke(
+    uint8_t* response, uint32_t message_length, uint32_t* actual_length, shim_ctx_ptr_t ctx
+);
@@ -0,0 +1,127 @@
+// Measures the speedup of the parallel tally over 1 to max_threads worker threads on a
+// synthetic election, and writes the median time of every thread count as JSON.
+//
+// usage: tally_bench [num_votes] [max_threads] [output.json] [repetitions]
+//
+// The votes point into a pool of distinct vote JSON strings, so that large elections
+// only cost a pointer per vote in memory. The pool is much larger than a CPU cache, but
+// votes still repeat, so the times are optimistic compared to votes read from the ledger.
+
+#include "election_tally.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#define VOTE_POOL_SIZE (1 << 23)
+
+typedef struct tally_run_t
+{
+    unsigned num_threads;
+    double seconds;
+    std::vector<double> samples;
+} tally_run_t;
+
+int main(int argc, char** argv)
+{
+    uint64_t num_votes = (argc > 1) ? strtoull(argv[1], NULL, 10) : 100000000;
+    unsigned max_threads = (argc > 2) ? strtoul(argv[2], NULL, 10) : 64;
+    const char* output_path = (argc > 3 && argv[3][0] != '\0') ? argv[3] : NULL;
+    unsigned repetitions = (argc > 4) ? std::max(strtoul(argv[4], NULL, 10), 1ul) : 5;
+
+    election_t election;
+    election.name = "electionBench";
+    election.candidate_one = "ben";
+    election.candidate_two = "simon";
+    election.candidate_three = "jim";
+
+    // uneven shares, so a shard that is dropped or counted twice changes the result
+    std::vector<std::string> pool(std::min((uint64_t)VOTE_POOL_SIZE, num_votes));
+    for (size_t i = 0; i < pool.size(); i++)
+    {
+        vote_t vote;
+        vote.vote_from = "voter" + std::to_string(i);
+        vote.vote_to = (i % 7 < 3) ? election.candidate_one
+            : (i % 7 < 5) ? election.candidate_two : election.candidate_three;
+        pool[i] = marshal_vote(&vote);
+    }
+
+    std::vector<const std::string*> votes(num_votes);
+    for (uint64_t i = 0; i < num_votes; i++)
+    {
+        votes[i] = &pool[i % pool.size()];
+    }
+
+    // an untimed single-threaded pass warms up the pool and gives the expected tally
+    tally_t expected = tally_votes(votes, &election, 1);
+
+    std::vector<tally_run_t> runs;
+    for (unsigned num_threads = 1; num_threads <= max_threads; num_threads *= 2)
+    {
+        tally_run_t run;
+        run.num_threads = num_threads;
+
+        for (unsigned r = 0; r < repetitions; r++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            tally_t tally = tally_votes(votes, &election, num_threads);
+            auto end = std::chrono::steady_clock::now();
+
+            if (tally.c_one_count != expected.c_one_count
+                || tally.c_two_count != expected.c_two_count
+                || tally.c_three_count != expected.c_three_count)
+            {
+                fprintf(stderr, "Tally with %u threads differs from the single-threaded one\n", num_threads);
+                return 1;
+            }
+
+            run.samples.push_back(std::chrono::duration<double>(end - start).count());
+        }
+
+        // the median of the repetitions
+        std::vector<double> sorted(run.samples);
+        std::sort(sorted.begin(), sorted.end());
+        size_t middle = sorted.size() / 2;
+        run.seconds = (sorted.size() % 2) ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2;
+        runs.push_back(run);
+
+        fprintf(stderr, "%2u threads: %8.3f s median of %u, speedup %5.2fx\n",
+            num_threads, run.seconds, repetitions, runs[0].seconds / run.seconds);
+    }
+
+    FILE* out = output_path ? fopen(output_path, "w") : stdout;
+    if (out == NULL)
+    {
+        fprintf(stderr, "Could not open %s\n", output_path);
+        return 1;
+    }
+
+    fprintf(out, "{\n  \"votes\": %llu,\n  \"repetitions\": %u,\n  \"tally\": [%llu, %llu, %llu],\n  \"runs\": [\n",
+        (unsigned long long)num_votes, repetitions, (unsigned long long)expected.c_one_count,
+        (unsigned long long)expected.c_two_count, (unsigned long long)expected.c_three_count);
+    for (size_t i = 0; i < runs.size(); i++)
+    {
+        std::string samples;
+        for (double sample : runs[i].samples)
+        {
+            char buf[32];
+            snprintf(buf, sizeof(buf), "%s%.3f", samples.empty() ? "" : ", ", sample);
+            samples += buf;
+        }
+
+        fprintf(out, "    {\"threads\": %u, \"seconds\": %.3f, \"votes_per_second\": %.0f, \"speedup\": %.2f, "
+            "\"samples\": [%s]}%s\n",
+            runs[i].num_threads, runs[i].seconds, num_votes / runs[i].seconds,
+            runs[0].seconds / runs[i].seconds, samples.c_str(), (i + 1 < runs.size()) ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    return 0;
+}
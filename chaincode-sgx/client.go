@@ -1,7 +1,10 @@
 package main
 
 import (
+	"encoding/json"
 	"os"
+	"strconv"
+	"time"
 
 	fpc "github.com/hyperledger/fabric-private-chaincode/client_sdk/go/pkg/gateway"
 	"github.com/hyperledger/fabric-private-chaincode/integration/client_sdk/go/utils"
@@ -37,7 +40,9 @@ func main() {
 
 	// 2. Submit vote for candidate Ben
 	logger.Infof("--> Invoke e-voting chaincode: Submit vote")
-	result, err = contract.SubmitTransaction("SubmitVote", "voter1", "ben")
+	result, err = contract.SubmitTransaction(
+		"SubmitVote", "electionPrime", "voter1", "ben", strconv.FormatInt(time.Now().Unix(), 10),
+	)
 	if err != nil {
 		logger.Fatalf("Could not submit vote: %v", err)
 	}
@@ -53,6 +58,23 @@ func main() {
 	logger.Infof("--> Result: %s", string(result))
 
 
+	// Fold the submissions so far into the turnout record, then check the turnout
+	// while the election is still open
+	logger.Infof("--> Invoke e-voting chaincode: Compact turnout")
+	result, err = contract.SubmitTransaction("CompactTurnout", "electionPrime")
+	if err != nil {
+		logger.Fatalf("Could not compact turnout: %v", err)
+	}
+	logger.Infof("--> Result: %s", string(result))
+
+	logger.Infof("--> Invoke e-voting chaincode: Query turnout")
+	result, err = contract.EvaluateTransaction("QueryTurnout", "electionPrime")
+	if err != nil {
+		logger.Fatalf("Could not query turnout: %v", err)
+	}
+	logger.Infof("--> Result: %s", string(result))
+
+
 	// 4. Close the election and evaluate the candidate w/ most votes
 	logger.Infof("--> Invoke e-voting chaincode: Close the election")
 	result, err = contract.SubmitTransaction("CloseElection", "electionPrime")
@@ -61,6 +83,27 @@ func main() {
 	}
 	logger.Infof("--> Result: %s", string(result))
 
+
+	// As the organizer, page through the votes of the closed election, 4KB at a time
+	logger.Infof("--> Invoke e-voting chaincode: Query votes")
+	bookmark := ""
+	for {
+		result, err = contract.EvaluateTransaction("QueryVotes", "electionPrime", "4096", bookmark)
+		if err != nil {
+			logger.Fatalf("Could not query votes: %v", err)
+		}
+		logger.Infof("--> Result: %s", string(result))
+
+		var page struct {
+			Bookmark string `json:"bookmark"`
+		}
+		if err = json.Unmarshal(result, &page); err != nil || page.Bookmark == "" {
+			break
+		}
+		bookmark = page.Bookmark
+	}
+
+
 	
 	logger.Infof("--> Invoke e-voting chaincode: Evaluate election")
 	result, err = contract.EvaluateTransaction("EvaluateElection", "electionPrime")
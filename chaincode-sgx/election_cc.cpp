@@ -1,11 +1,35 @@
 #include "shim.h"
 #include "election_cc.h"
 #include "election_json.h"
+#include "election_tally.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
 #include <numeric>
+#include <set>
 #include <vector>
 
 #define MAX_VALUE_SIZE 1024
+// composite keys start with their type and join their parts with SEP, which names cannot contain
+#define SEP "\x01"
+#define VOTE_PREFIX "vote"
+#define TURNOUT_PREFIX "turnout"
+#define SUBMISSION_PREFIX "submission"
+#define COUNTED_PREFIX "counted"
+#define OUTCOME_PREFIX "outcome"
+// votes only write a key of their own for the turnout, which compactions fold into one
+// record of one-minute windows, merged further once there are more than the maximum
+#define TURNOUT_WINDOW 60
+#define TURNOUT_MAX_BUCKETS 1440
+#define TURNOUT_MAX_SIZE 65536
+// submission times outside [2020-01-01, 2100-01-01) are rejected
+#define TURNOUT_MIN_TIME 1577836800
+#define TURNOUT_MAX_TIME 4102444800
+
+// worker threads of a native evaluation, 0 for one per core
+#define TALLY_THREADS 0
 
 #define OK "OK"
 #define ELECTION_DRAW "DRAW"
@@ -16,6 +40,13 @@
 #define ELECTION_STILL_OPEN "ELECTION_STILL_OPEN"
 #define VOTE_DOES_NOT_EXIST "VOTE_DOES_NOT_EXIST"
 #define VOTE_NOT_FOUND "VOTE_NOT_FOUND"
+#define PAGE_SIZE_TOO_SMALL "PAGE_SIZE_TOO_SMALL"
+#define INVALID_TIMESTAMP "INVALID_TIMESTAMP"
+#define INVALID_NAME "INVALID_NAME"
+#define ACCESS_DENIED "ACCESS_DENIED"
+
+// bytes taken by {"votes":[],"bookmark":""} around the page records
+#define VOTE_PAGE_ENVELOPE 26
 
 #define INITIALIZED_KEY "initialized"
 #define ELECTION_NAME_KEY "election_name"
@@ -67,7 +98,16 @@ std::string createElection(
     // create new election
     election_t new_election;
     new_election.name = (char*)election_name.c_str();
-    new_election.organizer = get_creator_name('org1msp', (uint8_t*)election_name.c_str(), election_name.size(), ctx)
+    char organizer_msp_id[1024];
+    char organizer_dn[1024];
+    get_creator_name(
+        organizer_msp_id, 
+        sizeof(organizer_msp_id),
+        organizer_dn, 
+        sizeof(organizer_dn), 
+        ctx
+    );
+    new_election.organizer = organizer_dn;
     new_election.winner = "";
     new_election.num_votes = 0;
     new_election.status = "open";
@@ -84,7 +124,7 @@ std::string createElection(
     return OK;
 }
 
-election_t queryElection(std::string election_name, shim_ctx_ptr_t ctx) 
+std::string queryElection(std::string election_name, shim_ctx_ptr_t ctx) 
 {
     // check if election already exists
     uint32_t election_bytes_len = 0;
@@ -101,17 +141,134 @@ election_t queryElection(std::string election_name, shim_ctx_ptr_t ctx)
     unmarshal_election(&election, (const char*)election_bytes, election_bytes_len);
 
     LOG_DEBUG(
-        "Election - Name: (%s) Candidates: (%s, %s, %s) Status (%d)", 
+        "Election - Name: (%s) Candidates: (%s, %s, %s) Status (%s)", 
         election.name.c_str(), 
         election.candidate_one.c_str(), election.candidate_two.c_str(), election.candidate_three.c_str(), 
-        election.status
+        election.status.c_str()
     );
 
-    return election;
+    return marshal_election(&election);
+}
+
+// Key of the compacted turnout of an election
+static std::string turnout_key(std::string election_name)
+{
+    return TURNOUT_PREFIX SEP + election_name + SEP;
+}
+
+// Partial key of every submission not yet compacted into the turnout of an election
+static std::string submission_prefix(std::string election_name)
+{
+    return SUBMISSION_PREFIX SEP + election_name + SEP;
+}
+
+// Key of one submission, unique to its voter and time so that votes never write the same key
+static std::string submission_key(std::string election_name, std::string voter_name, uint64_t submitted_at)
+{
+    return submission_prefix(election_name) + std::to_string(submitted_at) + SEP + voter_name + SEP;
+}
+
+// Key marking a voter as counted in num_votes of the compacted turnout
+static std::string counted_key(std::string election_name, std::string voter_name)
+{
+    return COUNTED_PREFIX SEP + election_name + SEP + voter_name + SEP;
+}
+
+// Count one submission in the turnout, doubling the width of the windows while
+// there are more than TURNOUT_MAX_BUCKETS of them
+static void add_submission(turnout_t* turnout, uint64_t submitted_at, bool new_voter)
+{
+    if (new_voter)
+    {
+        turnout->num_votes += 1;
+    }
+    turnout->num_submissions += 1;
+    turnout->last_submitted = std::max(turnout->last_submitted, (double)submitted_at);
+
+    uint64_t window = turnout->window;
+    turnout->buckets[submitted_at - submitted_at % window] += 1;
+
+    while (turnout->buckets.size() > TURNOUT_MAX_BUCKETS)
+    {
+        window *= 2;
+        std::map<uint64_t, uint32_t> merged;
+        for (auto& bucket : turnout->buckets)
+        {
+            merged[bucket.first - bucket.first % window] += bucket.second;
+        }
+        turnout->buckets.swap(merged);
+    }
+    turnout->window = window;
+}
+
+// Read the compacted turnout and add the submissions made since the last compaction.
+// With compact, the result is stored back and those submissions are deleted, so that
+// later reads only cost the submissions made after it.
+static void get_turnout(std::string election_name, turnout_t* turnout, bool compact, shim_ctx_ptr_t ctx)
+{
+    turnout->num_votes = 0;
+    turnout->num_submissions = 0;
+    turnout->window = TURNOUT_WINDOW;
+    turnout->last_submitted = 0;
+
+    std::string key = turnout_key(election_name);
+    std::vector<uint8_t> turnout_bytes(TURNOUT_MAX_SIZE);
+    uint32_t turnout_bytes_len = 0;
+    get_state(key.c_str(), turnout_bytes.data(), turnout_bytes.size() - 1, &turnout_bytes_len, ctx);
+
+    if (turnout_bytes_len > 0)
+    {
+        turnout_bytes[turnout_bytes_len] = '\0';
+        unmarshal_turnout(turnout, (const char*)turnout_bytes.data(), turnout_bytes_len);
+    }
+
+    std::string prefix = submission_prefix(election_name);
+    std::map<std::string, std::string> submissions;
+    get_state_by_partial_composite_key(prefix.c_str(), submissions, ctx);
+
+    std::set<std::string> voters;
+    for (auto& submission : submissions)
+    {
+        // the key ends in <submitted_at> SEP <voter> SEP
+        uint64_t submitted_at = strtoull(submission.first.c_str() + prefix.size(), NULL, 10);
+        size_t voter_pos = submission.first.find(SEP, prefix.size()) + 1;
+        std::string voter_name = submission.first.substr(voter_pos, submission.first.size() - voter_pos - 1);
+
+        // a voter is new if neither an earlier compaction nor this one has counted them
+        bool new_voter = false;
+        if (voters.insert(voter_name).second)
+        {
+            std::string voter_key = counted_key(election_name, voter_name);
+            uint8_t counted = 0;
+            uint32_t counted_len = 0;
+            get_state(voter_key.c_str(), &counted, sizeof(counted), &counted_len, ctx);
+            new_voter = (counted_len == 0);
+
+            if (compact && new_voter)
+            {
+                counted = 1;
+                put_state(voter_key.c_str(), &counted, sizeof(counted), ctx);
+            }
+        }
+
+        add_submission(turnout, submitted_at, new_voter);
+
+        if (compact)
+        {
+            del_state(submission.first.c_str(), ctx);
+        }
+    }
+
+    if (compact && !submissions.empty())
+    {
+        std::string json = marshal_turnout(turnout);
+        put_state(key.c_str(), (uint8_t*)json.c_str(), json.size(), ctx);
+    }
 }
 
 std::string submitVote(
-    std::string election_name, std::string voter_name, std::string vote_to, shim_ctx_ptr_t ctx
+    std::string election_name, std::string voter_name, std::string vote_to, uint64_t submitted_at, 
+    shim_ctx_ptr_t ctx
 ) 
 {
     // check if election already exists
@@ -129,14 +286,14 @@ std::string submitVote(
     election_t election;
     unmarshal_election(&election, (const char*)election_bytes, election_bytes_len);
 
-    if (!election.status) {
+    if (election.status != "open") {
         LOG_DEBUG("Election must be open to submit new votes.");
         return ELECTION_ALREADY_CLOSED;
     }
 
     // Create composite key to encrypt vote
     // If vote already exists, we just overwrite it
-    std::string new_key("\u00" + election_name + "\u0" + voter_name + "\u0");
+    std::string new_key(VOTE_PREFIX SEP + election_name + SEP + voter_name + SEP);
 
     vote_t new_vote;
     new_vote.vote_from = voter_name;
@@ -146,6 +303,12 @@ std::string submitVote(
     std::string json = marshal_vote(&new_vote);
     put_state(new_key.c_str(), (uint8_t*)json.c_str(), json.size(), ctx);
 
+    // record the submission for the turnout under a key of its own, without reading any
+    // turnout state, so that turnout bookkeeping can never make a vote conflict
+    std::string turnout_submission_key = submission_key(election_name, voter_name, submitted_at);
+    uint8_t submitted = 1;
+    put_state(turnout_submission_key.c_str(), &submitted, sizeof(submitted), ctx);
+
     return OK;
 }
 
@@ -166,14 +329,19 @@ std::string closeElection(std::string election_name, shim_ctx_ptr_t ctx)
     election_t election;
     unmarshal_election(&election, (const char*)election_bytes, election_bytes_len);
 
-    if (!election.status)
+    if (election.status != "open")
     {
         LOG_DEBUG("Election is already closed.");
         return ELECTION_ALREADY_CLOSED;
     }
 
     // close election
-    election.status = false;
+    election.status = "closed";
+
+    // the turnout is final once the election is closed
+    turnout_t turnout;
+    get_turnout(election_name, &turnout, true, ctx);
+    election.num_votes = turnout.num_votes;
 
     // convert to json and store in state
     std::string json = marshal_election(&election);
@@ -205,7 +373,7 @@ std::string queryVote(std::string election_name, std::string voter_name, shim_ct
     unmarshal_election(&election, (const char*)election_bytes, election_bytes_len);
 
     // Get the votes w/ partial composite key
-    std::string voter_key = "\u00" + election_name + "\u0";
+    std::string voter_key = VOTE_PREFIX SEP + election_name + SEP;
     std::map<std::string, std::string> votes;
     get_state_by_partial_composite_key(voter_key.c_str(), votes, ctx);
 
@@ -236,6 +404,175 @@ std::string queryVote(std::string election_name, std::string voter_name, shim_ct
     return VOTE_NOT_FOUND;
 }
 
+// Returns the votes after the bookmark, at most page_size bytes of JSON per call.
+// Ballots are secret, so only the organizer can list them, and only once the election is closed.
+std::string queryVotes(
+    std::string election_name, uint32_t page_size, std::string bookmark, shim_ctx_ptr_t ctx
+) 
+{
+    // Check if election exists
+    uint32_t election_bytes_len = 0;
+    uint8_t election_bytes[MAX_VALUE_SIZE];
+    get_state(
+        election_name.c_str(), 
+        election_bytes, 
+        sizeof(election_bytes), 
+        &election_bytes_len, 
+        ctx
+    );
+
+    if (election_bytes_len == 0) 
+    {
+        LOG_DEBUG("Election needs to exist.");
+        return ELECTION_DOES_NOT_EXIST;
+    }
+
+    election_t election;
+    unmarshal_election(&election, (const char*)election_bytes, election_bytes_len);
+
+    if (election.status == "open") 
+    {
+        LOG_DEBUG("Election must be closed to list its votes.");
+        return ELECTION_STILL_OPEN;
+    }
+
+    char caller_msp_id[1024];
+    char caller_dn[1024];
+    get_creator_name(
+        caller_msp_id, 
+        sizeof(caller_msp_id),
+        caller_dn, 
+        sizeof(caller_dn), 
+        ctx
+    );
+
+    if (election.organizer != caller_dn) 
+    {
+        LOG_DEBUG("Only the organizer of the election can list its votes.");
+        return ACCESS_DENIED;
+    }
+
+    // Get the votes w/ partial composite key
+    std::string voter_key = VOTE_PREFIX SEP + election_name + SEP;
+    std::map<std::string, std::string> votes;
+    get_state_by_partial_composite_key(voter_key.c_str(), votes, ctx);
+
+    // The shim has no paginated range query, so every page reads all votes of the election
+    // and resumes right after the last voter of the previous page
+    auto it = votes.begin();
+    if (!bookmark.empty()) 
+    {
+        it = votes.upper_bound(voter_key + bookmark + SEP);
+    }
+
+    vote_page_t page;
+    uint32_t used = VOTE_PAGE_ENVELOPE;
+    for (; it != votes.end(); ++it) 
+    {
+        vote_t vote;
+        unmarshal_vote(&vote, it->second.c_str(), it->second.size());
+
+        // the record and its separating comma as they appear in the page, plus the
+        // bookmark it would leave behind, escaped like every other JSON string
+        uint32_t record_size = marshal_vote(&vote).size() + 1;
+        uint32_t bookmark_size = marshal_string(vote.vote_from).size() - 2;
+        if (used + record_size + bookmark_size > page_size) 
+        {
+            break;
+        }
+
+        used += record_size;
+        page.votes.push_back(vote);
+    }
+
+    if (page.votes.empty() && it != votes.end()) 
+    {
+        LOG_DEBUG("Page size %u cannot hold a single vote.", page_size);
+        return PAGE_SIZE_TOO_SMALL;
+    }
+
+    // Only leave a bookmark if there is something left to read
+    if (it != votes.end()) 
+    {
+        page.bookmark = page.votes.back().vote_from;
+    }
+
+    LOG_DEBUG(
+        "Vote page - Election: %s, Votes: %d, Bookmark: %s", 
+        election_name.c_str(), 
+        (int)page.votes.size(), 
+        page.bookmark.c_str()
+    );
+
+    return marshal_vote_page(&page);
+}
+
+// Returns the running turnout and the votes submitted per time window
+std::string queryTurnout(std::string election_name, shim_ctx_ptr_t ctx) 
+{
+    // Check if election exists
+    uint32_t election_bytes_len = 0;
+    uint8_t election_bytes[MAX_VALUE_SIZE];
+    get_state(
+        election_name.c_str(), 
+        election_bytes, 
+        sizeof(election_bytes), 
+        &election_bytes_len, 
+        ctx
+    );
+
+    if (election_bytes_len == 0) 
+    {
+        LOG_DEBUG("Election needs to exist.");
+        return ELECTION_DOES_NOT_EXIST;
+    }
+
+    turnout_t turnout;
+    get_turnout(election_name, &turnout, false, ctx);
+
+    LOG_DEBUG(
+        "Turnout - Election: %s, Voters: %d, Submissions: %d, Windows: %d", 
+        election_name.c_str(), 
+        (int)turnout.num_votes, 
+        (int)turnout.num_submissions, 
+        (int)turnout.buckets.size()
+    );
+
+    return marshal_turnout(&turnout);
+}
+
+// Folds the submissions made since the last compaction into the stored turnout
+std::string compactTurnout(std::string election_name, shim_ctx_ptr_t ctx) 
+{
+    // Check if election exists
+    uint32_t election_bytes_len = 0;
+    uint8_t election_bytes[MAX_VALUE_SIZE];
+    get_state(
+        election_name.c_str(), 
+        election_bytes, 
+        sizeof(election_bytes), 
+        &election_bytes_len, 
+        ctx
+    );
+
+    if (election_bytes_len == 0) 
+    {
+        LOG_DEBUG("Election needs to exist.");
+        return ELECTION_DOES_NOT_EXIST;
+    }
+
+    turnout_t turnout;
+    get_turnout(election_name, &turnout, true, ctx);
+
+    LOG_DEBUG(
+        "Turnout compacted - Election: %s, Submissions: %d", 
+        election_name.c_str(), 
+        (int)turnout.num_submissions
+    );
+
+    return OK;
+}
+
 std::string evaluateElection(std::string election_name, shim_ctx_ptr_t ctx) 
 {
     // check if election already exists
@@ -260,7 +597,7 @@ std::string evaluateElection(std::string election_name, shim_ctx_ptr_t ctx)
     unmarshal_election(&election, (const char*)election_bytes, election_bytes_len);
 
     // check if election is closed
-    if (election.status)
+    if (election.status == "open")
     {
         LOG_DEBUG("Election must be closed to evaluate winner.");
         return ELECTION_STILL_OPEN;
@@ -270,10 +607,7 @@ std::string evaluateElection(std::string election_name, shim_ctx_ptr_t ctx)
     std::string election_result;
 
     // get all votes
-    std::string vote_composite_key = "\u00" + election_name + "\u0";
-    int c_one_count = 0;
-    int c_two_count = 0;
-    int c_three_count = 0;
+    std::string vote_composite_key = VOTE_PREFIX SEP + election_name + SEP;
     std::map<std::string, std::string> votes;
     get_state_by_partial_composite_key(vote_composite_key.c_str(), votes, ctx);
 
@@ -284,30 +618,27 @@ std::string evaluateElection(std::string election_name, shim_ctx_ptr_t ctx)
     }
     else
     {
-        // Find candidate w/ most votes
-        LOG_DEBUG("All considered votes:");
-        for (auto v : votes)
+        // Count the votes of each candidate, on worker threads outside of the enclave
+        std::vector<const std::string*> vote_values;
+        vote_values.reserve(votes.size());
+        for (auto& v : votes)
         {
-            vote_t vote;
-            unmarshal_vote(&vote, v.second.c_str(), v.second.size());
+            vote_values.push_back(&v.second);
+        }
 
-            LOG_DEBUG(
-                "Election: Voter \t%s picked candidate: %d", 
-                vote.vote_from.c_str(), 
-                vote.vote_to.c_str()
-            );
+        tally_t tally = tally_votes(vote_values, &election, TALLY_THREADS);
+        uint64_t c_one_count = tally.c_one_count;
+        uint64_t c_two_count = tally.c_two_count;
+        uint64_t c_three_count = tally.c_three_count;
 
-            if (vote.vote_to.c_str() == election.candidate_one) 
-            {
-                c_one_count += 1;
-            } else if (vote.vote_to.c_str() == election.candidate_two) 
-            {
-                c_two_count += 1;
-            } else {
-                c_three_count += 1;
-            }
-        }
+        LOG_DEBUG(
+            "Election: %s: %d, %s: %d, %s: %d", 
+            election.candidate_one.c_str(), (int)c_one_count, 
+            election.candidate_two.c_str(), (int)c_two_count, 
+            election.candidate_three.c_str(), (int)c_three_count
+        );
 
+        // Find candidate w/ most votes
         candidate_t winner;
         winner.name = "";
         winner.num_votes = -1;
@@ -342,7 +673,7 @@ std::string evaluateElection(std::string election_name, shim_ctx_ptr_t ctx)
 
         if (draw != 1)
         {
-            LOG_DEBUG("Winner is: %s with %d votes", winner.name.c_str(), winner.num_votes);
+            LOG_DEBUG("Winner is: %s with %d votes", winner.name.c_str(), (int)winner.num_votes);
             election.winner = winner.name.c_str();
             election_result = marshal_candidate(&winner);
         }
@@ -354,7 +685,7 @@ std::string evaluateElection(std::string election_name, shim_ctx_ptr_t ctx)
     }
 
     // We can publicly store the result of the election
-    std::string election_result_key(election_name + SEP + "outcome" + SEP);
+    std::string election_result_key(OUTCOME_PREFIX SEP + election_name + SEP);
 
     put_public_state(
         election_result_key.c_str(), 
@@ -439,7 +770,7 @@ int invoke(
     );
 
     std::string election_name = params[0];
-    std::string chaincode_result;
+    std::string result;
 
     if (!_initialized_ && function_name != "init")
     {
@@ -448,7 +779,15 @@ int invoke(
         return -1;
     }
 
-    if (function_name == "init") 
+    // election and voter names are parts of composite keys
+    bool has_voter_name = (function_name == "SubmitVote" || function_name == "QueryVote");
+    if (election_name.find(SEP) != std::string::npos
+        || (has_voter_name && params.size() > 1 && params[1].find(SEP) != std::string::npos))
+    {
+        LOG_ERROR("Election and voter names cannot contain the key separator");
+        result = INVALID_NAME;
+    }
+    else if (function_name == "init") 
     {
         result = initElection(params[0], ctx);
     }
@@ -484,6 +823,19 @@ int invoke(
     {
         std::string voter_name = params[1];
         std::string vote_to = params[2];
+
+        // the submission time is supplied by the client, in unix seconds
+        uint64_t submitted_at = 0;
+        char* submitted_at_end = NULL;
+        if (params.size() > 3 && isdigit((unsigned char)params[3][0]))
+        {
+            errno = 0;
+            submitted_at = strtoull(params[3].c_str(), &submitted_at_end, 10);
+            if (errno == ERANGE)
+            {
+                submitted_at_end = NULL;
+            }
+        }
         
         char voter_name_msp_id[1024];
         char voter_name_dn[1024];
@@ -502,13 +854,41 @@ int invoke(
             voter_name.c_str()
         );
 
-        result = submitVote(election_name, voter_name, vote_to, ctx);
+        if (submitted_at_end == NULL || *submitted_at_end != '\0'
+            || submitted_at < TURNOUT_MIN_TIME || submitted_at >= TURNOUT_MAX_TIME)
+        {
+            LOG_ERROR("SubmitVote needs the submission time in unix seconds, between 2020 and 2100");
+            result = INVALID_TIMESTAMP;
+        }
+        else
+        {
+            result = submitVote(election_name, voter_name, vote_to, submitted_at, ctx);
+        }
     }
     else if (function_name == "QueryVote") 
     {
         std::string voter_name = params[1];
         result = queryVote(election_name, voter_name, ctx);
     }
+    else if (function_name == "QueryVotes") 
+    {
+        // the page never exceeds the response buffer we have been given
+        uint32_t page_size = message_length;
+        if (params.size() > 1) 
+        {
+            page_size = std::min(page_size, (uint32_t)strtoul(params[1].c_str(), NULL, 10));
+        }
+        std::string bookmark = (params.size() > 2) ? params[2] : "";
+        result = queryVotes(election_name, page_size, bookmark, ctx);
+    }
+    else if (function_name == "QueryTurnout") 
+    {
+        result = queryTurnout(election_name, ctx);
+    }
+    else if (function_name == "CompactTurnout") 
+    {
+        result = compactTurnout(election_name, ctx);
+    }
     else if (function_name == "CloseElection") 
     {
         result = closeElection(election_name, ctx);
@@ -525,7 +905,7 @@ int invoke(
         return -1;
     }
 
-    int size = result.size();
+    uint32_t size = result.size();
     if (message_length < size)
     {
         // error:  buffer too small for the response to be sent
@@ -11,11 +11,12 @@ std::string createElection(
     std::string candidate_one, std::string candidate_two, std::string candidate_three, 
     shim_ctx_ptr_t ctx
 );
-election_t queryElection(
+std::string queryElection(
     std::string election_name, shim_ctx_ptr_t ctx
 );
 std::string submitVote(
-    std::string election_name, std::string voter_name, std::string vote_to, shim_ctx_ptr_t ctx
+    std::string election_name, std::string voter_name, std::string vote_to, uint64_t submitted_at, 
+    shim_ctx_ptr_t ctx
 );
 std::string closeElection(
     std::string election_name, shim_ctx_ptr_t ctx
@@ -23,6 +24,15 @@ std::string closeElection(
 std::string queryVote(
     std::string election_name, std::string voter_name, shim_ctx_ptr_t ctx
 );
+std::string queryVotes(
+    std::string election_name, uint32_t page_size, std::string bookmark, shim_ctx_ptr_t ctx
+);
+std::string queryTurnout(
+    std::string election_name, shim_ctx_ptr_t ctx
+);
+std::string compactTurnout(
+    std::string election_name, shim_ctx_ptr_t ctx
+);
 std::string evaluateElection(
     std::string election_name, shim_ctx_ptr_t ctx
 );
@@ -1,6 +1,6 @@
 #include "parson.h"
 #include "election_json.h"
-#include "struct_mapping/struct_mapping.h"
+#include <cstdlib>
 
 // Unmarshal
 void unmarshal_election(election_t* election, const char* json_bytes, uint32_t json_len)
@@ -15,7 +15,6 @@ void unmarshal_election(election_t* election, const char* json_bytes, uint32_t j
     election->num_votes = json_object_get_number(json_object(root), "num_votes");
     election->status = json_object_get_string(json_object(root), "status");
     json_value_free(root);
-    return 1;
 }
 
 void unmarshal_hash(hash_t* hash_vote, const char* json_bytes, uint32_t json_len) 
@@ -23,7 +22,6 @@ void unmarshal_hash(hash_t* hash_vote, const char* json_bytes, uint32_t json_len
     JSON_Value* root = json_parse_string(json_bytes);
     hash_vote->hash = json_object_get_string(json_object(root), "hash");
     json_value_free(root);
-    return 1;
 }
 
 void unmarshal_vote(vote_t* vote, const char* json_bytes, uint32_t json_len)
@@ -32,7 +30,6 @@ void unmarshal_vote(vote_t* vote, const char* json_bytes, uint32_t json_len)
     vote->vote_from = json_object_get_string(json_object(root), "vote_from");
     vote->vote_to = json_object_get_string(json_object(root), "vote_to");
     json_value_free(root);
-    return 1;
 }
 
 void unmarshal_candidate(candidate_t* candidate, const char* json_bytes, uint32_t json_len) 
@@ -41,7 +38,22 @@ void unmarshal_candidate(candidate_t* candidate, const char* json_bytes, uint32_
     candidate->name = json_object_get_string(json_object(root), "name");
     candidate->num_votes = json_object_get_number(json_object(root), "num_votes");
     json_value_free(root);
-    return 1;
+}
+
+void unmarshal_turnout(turnout_t* turnout, const char* json_bytes, uint32_t json_len) 
+{
+    JSON_Value* root = json_parse_string(json_bytes);
+    turnout->num_votes = json_object_get_number(json_object(root), "num_votes");
+    turnout->num_submissions = json_object_get_number(json_object(root), "num_submissions");
+    turnout->window = json_object_get_number(json_object(root), "window");
+    turnout->last_submitted = json_object_get_number(json_object(root), "last_submitted");
+    JSON_Object* buckets = json_object_get_object(json_object(root), "buckets");
+    for (size_t i = 0; i < json_object_get_count(buckets); i++) 
+    {
+        uint64_t start = strtoull(json_object_get_name(buckets, i), NULL, 10);
+        turnout->buckets[start] = (uint32_t)json_number(json_object_get_value_at(buckets, i));
+    }
+    json_value_free(root);
 }
 
 // Marshal
@@ -101,3 +113,59 @@ std::string marshal_candidate(candidate_t* candidate)
     json_value_free(root_value);
     return out;
 }
+
+std::string marshal_vote_page(vote_page_t* page) 
+{
+    JSON_Value* root_value = json_value_init_object();
+    JSON_Object* root_object = json_value_get_object(root_value);
+    JSON_Value* votes_value = json_value_init_array();
+    JSON_Array* votes_array = json_value_get_array(votes_value);
+    for (auto& vote : page->votes) 
+    {
+        JSON_Value* vote_value = json_value_init_object();
+        JSON_Object* vote_object = json_value_get_object(vote_value);
+        json_object_set_string(vote_object, "vote_from", vote.vote_from.c_str());
+        json_object_set_string(vote_object, "vote_to", vote.vote_to.c_str());
+        json_array_append_value(votes_array, vote_value);
+    }
+    json_object_set_value(root_object, "votes", votes_value);
+    json_object_set_string(root_object, "bookmark", page->bookmark.c_str());
+    char* serialized_string = json_serialize_to_string(root_value);
+    std::string out(serialized_string);
+    json_free_serialized_string(serialized_string);
+    json_value_free(root_value);
+    return out;
+}
+
+// A single JSON string, quoted and escaped as it would be inside an object
+std::string marshal_string(std::string value) 
+{
+    JSON_Value* root_value = json_value_init_string(value.c_str());
+    char* serialized_string = json_serialize_to_string(root_value);
+    std::string out(serialized_string);
+    json_free_serialized_string(serialized_string);
+    json_value_free(root_value);
+    return out;
+}
+
+std::string marshal_turnout(turnout_t* turnout) 
+{
+    JSON_Value* root_value = json_value_init_object();
+    JSON_Object* root_object = json_value_get_object(root_value);
+    json_object_set_number(root_object, "num_votes", turnout->num_votes);
+    json_object_set_number(root_object, "num_submissions", turnout->num_submissions);
+    json_object_set_number(root_object, "window", turnout->window);
+    json_object_set_number(root_object, "last_submitted", turnout->last_submitted);
+    JSON_Value* buckets_value = json_value_init_object();
+    JSON_Object* buckets_object = json_value_get_object(buckets_value);
+    for (auto& bucket : turnout->buckets) 
+    {
+        json_object_set_number(buckets_object, std::to_string(bucket.first).c_str(), bucket.second);
+    }
+    json_object_set_value(root_object, "buckets", buckets_value);
+    char* serialized_string = json_serialize_to_string(root_value);
+    std::string out(serialized_string);
+    json_free_serialized_string(serialized_string);
+    json_value_free(root_value);
+    return out;
+}
\ No newline at end of file
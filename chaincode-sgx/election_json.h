@@ -2,7 +2,9 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <map>
 #include <string>
+#include <vector>
 
 
 typedef struct candidate_t 
@@ -12,6 +14,19 @@ typedef struct candidate_t
 } candidate_t;
 
 
+typedef struct hash_t 
+{
+    std::string hash;
+} hash_t;
+
+
+typedef struct vote_t 
+{
+    std::string vote_from;
+    std::string vote_to;
+} vote_t;
+
+
 typedef struct election_t 
 {
     std::string name;
@@ -26,17 +41,25 @@ typedef struct election_t
     std::string status;
 } election_t;
 
-typedef struct hash_t 
+
+// Turnout of an election, as compacted from the submitted votes.
+// buckets maps the start of each window (unix seconds) to the votes submitted in it.
+typedef struct turnout_t 
 {
-    std::string hash;
-} hash_t;
+    double num_votes;
+    double num_submissions;
+    double window;
+    double last_submitted;
+    std::map<uint64_t, uint32_t> buckets;
+} turnout_t;
 
 
-typedef struct vote_t 
+// A page of votes; bookmark is the last voter returned, empty once exhausted
+typedef struct vote_page_t 
 {
-    std::string vote_from;
-    std::string vote_to;
-} vote_t;
+    std::vector<vote_t> votes;
+    std::string bookmark;
+} vote_page_t;
 
 
 // Unmarshal
@@ -44,9 +67,13 @@ void unmarshal_election(election_t* election, const char* json_bytes, uint32_t j
 void unmarshal_hash(hash_t* hash, const char* json_bytes, uint32_t json_len);
 void unmarshal_vote(vote_t* vote, const char* json_bytes, uint32_t json_len);
 void unmarshal_candidate(candidate_t* candidate, const char* json_bytes, uint32_t json_len);
+void unmarshal_turnout(turnout_t* turnout, const char* json_bytes, uint32_t json_len);
 
 // Marshal
 std::string marshal_election(election_t* election);
 std::string marshal_hash(hash_t* hash);
 std::string marshal_vote(vote_t* vote);
-std::string marshal_candidate(candidate_t* candidate);
\ No newline at end of file
+std::string marshal_candidate(candidate_t* candidate);
+std::string marshal_vote_page(vote_page_t* page);
+std::string marshal_string(std::string value);
+std::string marshal_turnout(turnout_t* turnout);
\ No newline at end of file
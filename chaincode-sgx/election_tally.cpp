@@ -0,0 +1,98 @@
+#include "election_tally.h"
+
+#ifdef ELECTION_PARALLEL_TALLY
+#include <algorithm>
+#include <functional>
+#include <system_error>
+#include <thread>
+
+// votes a shard gets at least, below which a thread costs more than it saves
+#define TALLY_MIN_SHARD_VOTES 4096
+#endif
+
+// Decode and count the votes in [begin, end) into a tally of its own
+static void tally_shard(
+    const std::vector<const std::string*>& votes, size_t begin, size_t end,
+    const election_t* election, tally_t* tally
+)
+{
+    tally_t local = {0, 0, 0};
+    for (size_t i = begin; i < end; i++)
+    {
+        vote_t vote;
+        unmarshal_vote(&vote, votes[i]->c_str(), votes[i]->size());
+
+        if (vote.vote_to == election->candidate_one)
+        {
+            local.c_one_count += 1;
+        } else if (vote.vote_to == election->candidate_two)
+        {
+            local.c_two_count += 1;
+        } else {
+            local.c_three_count += 1;
+        }
+    }
+    *tally = local;
+}
+
+tally_t tally_votes(
+    const std::vector<const std::string*>& votes, const election_t* election, unsigned num_threads
+)
+{
+    tally_t tally = {0, 0, 0};
+
+#ifdef ELECTION_PARALLEL_TALLY
+    if (num_threads == 0)
+    {
+        num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    size_t num_shards = std::min((size_t)num_threads, votes.size() / TALLY_MIN_SHARD_VOTES);
+
+    if (num_shards > 1)
+    {
+        // shard i holds the votes [i * n / num_shards, (i + 1) * n / num_shards)
+        auto shard_begin = [&](size_t i) { return i * votes.size() / num_shards; };
+        std::vector<tally_t> shard_tallies(num_shards);
+        std::vector<std::thread> workers;
+        workers.reserve(num_shards - 1);
+
+        // the calling thread counts the last shard, and any shard a thread could not be created for
+        size_t num_workers = 0;
+        try
+        {
+            for (; num_workers < num_shards - 1; num_workers++)
+            {
+                workers.emplace_back(
+                    tally_shard, std::cref(votes), shard_begin(num_workers), shard_begin(num_workers + 1),
+                    election, &shard_tallies[num_workers]
+                );
+            }
+        }
+        catch (const std::system_error&)
+        {
+            // out of threads, the shards left are counted below
+        }
+
+        for (size_t i = num_workers; i < num_shards; i++)
+        {
+            tally_shard(votes, shard_begin(i), shard_begin(i + 1), election, &shard_tallies[i]);
+        }
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+
+        for (auto& shard_tally : shard_tallies)
+        {
+            tally.c_one_count += shard_tally.c_one_count;
+            tally.c_two_count += shard_tally.c_two_count;
+            tally.c_three_count += shard_tally.c_three_count;
+        }
+        return tally;
+    }
+#endif
+
+    tally_shard(votes, 0, votes.size(), election, &tally);
+    return tally;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "election_json.h"
+
+
+// Number of votes for each candidate of an election
+typedef struct tally_t
+{
+    uint64_t c_one_count;
+    uint64_t c_two_count;
+    uint64_t c_three_count;
+} tally_t;
+
+
+// Counts the votes, given as their JSON in key order, for the candidates of the election.
+// Built with ELECTION_PARALLEL_TALLY, the votes are split into up to num_threads contiguous
+// shards (0 for one per core) of at least 4096 votes, that are counted on the calling thread
+// and worker threads and merged in shard order. Shards a thread cannot be created for are
+// counted on the calling thread. Otherwise, as in the enclave, all votes are counted on it.
+tally_t tally_votes(
+    const std::vector<const std::string*>& votes, const election_t* election, unsigned num_threads
+);
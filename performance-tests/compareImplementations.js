@@ -0,0 +1,65 @@
+const fs = require('fs');
+
+
+// Prints the results of two benchmarks, such as the Go and SGX C++ ones, side by side
+// for every operation, and writes them to a single JSON file if one is given
+function run() {
+    const resultPaths = [process.argv[2], process.argv[3]];
+    const outputPath = process.argv[4];
+
+    if (resultPaths.includes(undefined)) {
+        console.log('Please enter the two result files to compare.');
+        process.exit(1);
+    }
+
+    const results = resultPaths.map(
+        (resultPath) => JSON.parse(fs.readFileSync(resultPath, 'utf8'))
+    );
+    const names = results.map((result) => result.implementation);
+
+    const metrics = [
+        'calls', 'mean_us', 'p50_us', 'p99_us', 'total_us', 'state_reads', 'state_writes', 'bytes_written'
+    ];
+    const formatValue = (value) => (value == undefined) ? '-' : String(Math.round(value * 10) / 10);
+
+    // operations both implementations ran come first, then those only one of them has
+    const operations = [];
+    for (const result of results) {
+        for (const op of result.operations) {
+            if (!operations.includes(op.operation)) {
+                operations.push(op.operation);
+            }
+        }
+    }
+    const find = (result, operation) => result.operations.find((op) => op.operation == operation);
+    const shared = (operation) => results.every((result) => find(result, operation) != undefined);
+    operations.sort((a, b) => shared(b) - shared(a));
+
+    const columns = ['operation', 'metric', ...names];
+    let rows = [];
+    for (const operation of operations) {
+        metrics.forEach((metric, i) => {
+            rows.push([
+                (i == 0) ? operation : '', metric,
+                ...results.map((result) => formatValue((find(result, operation) || {})[metric]))
+            ]);
+        });
+    }
+
+    const widths = columns.map(
+        (column, i) => Math.max(column.length, ...rows.map((row) => row[i].length))
+    );
+    const format = (row) => row.map((cell, i) => cell.padEnd(widths[i])).join('  ').trimEnd();
+
+    console.log('\n--> ' + results.map((result) => `${result.votes} votes (${result.implementation})`).join(', ') + '\n');
+    console.log(format(columns));
+    console.log(format(widths.map((width) => '-'.repeat(width))));
+    rows.forEach((row) => console.log(format(row)));
+
+    if (outputPath != undefined) {
+        fs.writeFileSync(outputPath, JSON.stringify(results, null, 2));
+        console.log(`\n--> Results written to ${outputPath}`);
+    }
+}
+
+run();
@@ -0,0 +1,311 @@
+//go:build bench
+// +build bench
+
+package main
+
+// Runs a scripted election (create, N votes, close, evaluate) against the smart contract
+// through an in-process stand-in for the Fabric stub, and writes per-operation latency and
+// state access as JSON, in the same format as chaincode-sgx/bench.
+//
+// usage: go run -tags bench . -votes 1000 -out go.json
+
+import (
+	"crypto/sha256"
+	"crypto/x509"
+	"encoding/base64"
+	"encoding/json"
+	"flag"
+	"fmt"
+	"io/ioutil"
+	"log"
+	"os"
+	"sort"
+	"time"
+
+	"github.com/hyperledger/fabric-chaincode-go/shim"
+	"github.com/hyperledger/fabric-contract-api-go/contractapi"
+)
+
+const benchElection = "electionBench"
+
+type stubStats struct {
+	StateReads   uint64
+	StateWrites  uint64
+	BytesRead    uint64
+	BytesWritten uint64
+}
+
+// benchStub keeps the world state and the private data collections in memory and counts
+// every access. Stub methods the contract does not use are left to the nil embedded interface.
+type benchStub struct {
+	shim.ChaincodeStubInterface
+	state     map[string][]byte
+	private   map[string]map[string][]byte
+	transient map[string][]byte
+	txID      string
+	stats     stubStats
+}
+
+func newBenchStub() *benchStub {
+	return &benchStub{
+		state:   make(map[string][]byte),
+		private: make(map[string]map[string][]byte),
+	}
+}
+
+func (b *benchStub) read(value []byte) []byte {
+	b.stats.StateReads++
+	b.stats.BytesRead += uint64(len(value))
+	return value
+}
+
+func (b *benchStub) write(key string, value []byte) {
+	b.stats.StateWrites++
+	b.stats.BytesWritten += uint64(len(key) + len(value))
+}
+
+func (b *benchStub) GetState(key string) ([]byte, error) {
+	return b.read(b.state[key]), nil
+}
+
+func (b *benchStub) PutState(key string, value []byte) error {
+	b.write(key, value)
+	b.state[key] = value
+	return nil
+}
+
+func (b *benchStub) GetPrivateData(collection string, key string) ([]byte, error) {
+	return b.read(b.private[collection][key]), nil
+}
+
+func (b *benchStub) GetPrivateDataHash(collection string, key string) ([]byte, error) {
+	value := b.read(b.private[collection][key])
+	if value == nil {
+		return nil, nil
+	}
+	hash := sha256.Sum256(value)
+	return hash[:], nil
+}
+
+func (b *benchStub) PutPrivateData(collection string, key string, value []byte) error {
+	b.write(key, value)
+	if b.private[collection] == nil {
+		b.private[collection] = make(map[string][]byte)
+	}
+	b.private[collection][key] = value
+	return nil
+}
+
+func (b *benchStub) CreateCompositeKey(objectType string, attributes []string) (string, error) {
+	key := "\x00" + objectType + "\x00"
+	for _, attribute := range attributes {
+		key += attribute + "\x00"
+	}
+	return key, nil
+}
+
+func (b *benchStub) GetTxID() string {
+	return b.txID
+}
+
+func (b *benchStub) GetTransient() (map[string][]byte, error) {
+	return b.transient, nil
+}
+
+// benchIdentity is the client identity of the transaction being run
+type benchIdentity struct {
+	id    string
+	mspID string
+}
+
+func (i *benchIdentity) GetID() (string, error) {
+	return base64.StdEncoding.EncodeToString([]byte(i.id)), nil
+}
+
+func (i *benchIdentity) GetMSPID() (string, error) {
+	return i.mspID, nil
+}
+
+func (i *benchIdentity) GetAttributeValue(attrName string) (string, bool, error) {
+	return "", false, nil
+}
+
+func (i *benchIdentity) AssertAttributeValue(attrName, attrValue string) error {
+	return fmt.Errorf("attribute %v not found", attrName)
+}
+
+func (i *benchIdentity) GetX509Certificate() (*x509.Certificate, error) {
+	return nil, nil
+}
+
+type operation struct {
+	name      string
+	latencies []float64
+	stats     stubStats
+}
+
+type operationResult struct {
+	Operation    string  `json:"operation"`
+	Calls        int     `json:"calls"`
+	TotalUs      float64 `json:"total_us"`
+	MeanUs       float64 `json:"mean_us"`
+	P50Us        float64 `json:"p50_us"`
+	P99Us        float64 `json:"p99_us"`
+	MaxUs        float64 `json:"max_us"`
+	StateReads   uint64  `json:"state_reads"`
+	StateWrites  uint64  `json:"state_writes"`
+	BytesRead    uint64  `json:"bytes_read"`
+	BytesWritten uint64  `json:"bytes_written"`
+}
+
+type benchResult struct {
+	Implementation string            `json:"implementation"`
+	Votes          int               `json:"votes"`
+	Operations     []operationResult `json:"operations"`
+}
+
+// Runs one transaction as the given client and adds its latency and state access to op
+func (op *operation) run(stub *benchStub, client string, tx func(ctx *contractapi.TransactionContext) error) {
+	ctx := new(contractapi.TransactionContext)
+	ctx.SetStub(stub)
+	ctx.SetClientIdentity(&benchIdentity{id: client, mspID: "Org1MSP"})
+	before := stub.stats
+
+	start := time.Now()
+	err := tx(ctx)
+	elapsed := time.Since(start)
+
+	if err != nil {
+		log.Fatalf("%v failed: %v", op.name, err)
+	}
+
+	op.latencies = append(op.latencies, float64(elapsed.Nanoseconds())/1000)
+	op.stats.StateReads += stub.stats.StateReads - before.StateReads
+	op.stats.StateWrites += stub.stats.StateWrites - before.StateWrites
+	op.stats.BytesRead += stub.stats.BytesRead - before.BytesRead
+	op.stats.BytesWritten += stub.stats.BytesWritten - before.BytesWritten
+}
+
+// Nearest-rank percentile of the sorted latencies
+func percentile(sorted []float64, p float64) float64 {
+	if len(sorted) == 0 {
+		return 0
+	}
+	rank := int(p*float64(len(sorted)) + 0.5)
+	if rank < 1 {
+		rank = 1
+	}
+	if rank > len(sorted) {
+		rank = len(sorted)
+	}
+	return sorted[rank-1]
+}
+
+func (op *operation) result() operationResult {
+	sorted := append([]float64(nil), op.latencies...)
+	sort.Float64s(sorted)
+
+	total := 0.0
+	for _, latency := range sorted {
+		total += latency
+	}
+	mean := 0.0
+	if len(sorted) > 0 {
+		mean = total / float64(len(sorted))
+	}
+
+	return operationResult{
+		Operation:    op.name,
+		Calls:        len(sorted),
+		TotalUs:      total,
+		MeanUs:       mean,
+		P50Us:        percentile(sorted, 0.50),
+		P99Us:        percentile(sorted, 0.99),
+		MaxUs:        percentile(sorted, 1.0),
+		StateReads:   op.stats.StateReads,
+		StateWrites:  op.stats.StateWrites,
+		BytesRead:    op.stats.BytesRead,
+		BytesWritten: op.stats.BytesWritten,
+	}
+}
+
+func main() {
+	numVotes := flag.Int("votes", 1000, "number of votes to submit")
+	outputPath := flag.String("out", "", "file to write the results to (default stdout)")
+	flag.Parse()
+
+	// shim.GetMSPID reads the peer MSP ID from the environment
+	os.Setenv("CORE_PEER_LOCALMSPID", "Org1MSP")
+
+	contract := new(SmartContract)
+	stub := newBenchStub()
+	organizer := "x509::CN=organizer::CN=ca.org1.example.com"
+	candidates := []string{"ben", "simon", "jim"}
+
+	createOp := &operation{name: "CreateElection"}
+	addOp := &operation{name: "AddVote"}
+	submitOp := &operation{name: "SubmitVote"}
+	closeOp := &operation{name: "CloseElection"}
+	displayOp := &operation{name: "DisplayVote"}
+	evaluateOp := &operation{name: "EvaluateElection"}
+
+	createOp.run(stub, organizer, func(ctx *contractapi.TransactionContext) error {
+		return contract.CreateElection(ctx, benchElection, candidates[0], candidates[1], candidates[2])
+	})
+
+	// Each vote is stored privately, then its hash is submitted to the election
+	votes := make([][]byte, *numVotes)
+	for i := 0; i < *numVotes; i++ {
+		voter := fmt.Sprintf("x509::CN=voter%d::CN=ca.org1.example.com", i)
+		votes[i], _ = json.Marshal(PublicVote{VoteFrom: voter, VoteTo: candidates[i%3]})
+		stub.txID = fmt.Sprintf("tx%d", i)
+		stub.transient = map[string][]byte{"vote": votes[i]}
+
+		addOp.run(stub, voter, func(ctx *contractapi.TransactionContext) error {
+			_, err := contract.AddVote(ctx, benchElection)
+			return err
+		})
+		submitOp.run(stub, voter, func(ctx *contractapi.TransactionContext) error {
+			return contract.SubmitVote(ctx, benchElection, fmt.Sprintf("tx%d", i))
+		})
+	}
+
+	closeOp.run(stub, organizer, func(ctx *contractapi.TransactionContext) error {
+		return contract.CloseElection(ctx, benchElection)
+	})
+
+	// Votes only count once their voters have made them public
+	for i := 0; i < *numVotes; i++ {
+		voter := fmt.Sprintf("x509::CN=voter%d::CN=ca.org1.example.com", i)
+		stub.transient = map[string][]byte{"vote": votes[i]}
+
+		displayOp.run(stub, voter, func(ctx *contractapi.TransactionContext) error {
+			return contract.DisplayVote(ctx, benchElection, fmt.Sprintf("tx%d", i))
+		})
+	}
+
+	evaluateOp.run(stub, organizer, func(ctx *contractapi.TransactionContext) error {
+		_, err := contract.EvaluateElection(ctx, benchElection)
+		return err
+	})
+
+	result := benchResult{Implementation: "go-smartcontract", Votes: *numVotes}
+	for _, op := range []*operation{createOp, addOp, submitOp, closeOp, displayOp, evaluateOp} {
+		result.Operations = append(result.Operations, op.result())
+	}
+
+	resultJSON, err := json.MarshalIndent(result, "", "  ")
+	if err != nil {
+		log.Fatalf("failed to marshal results: %v", err)
+	}
+
+	if *outputPath == "" {
+		fmt.Println(string(resultJSON))
+		return
+	}
+
+	err = ioutil.WriteFile(*outputPath, append(resultJSON, '\n'), 0644)
+	if err != nil {
+		log.Fatalf("failed to write results: %v", err)
+	}
+}